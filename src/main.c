@@ -11,6 +11,9 @@
 #define PHYSICS_IMPLEMENTATION
 #include "physics.h"
 
+#define TELEMETRY_IMPLEMENTATION
+#include "telemetry.h"
+
 #define SCALE   64
 
 #define TOP                     16
@@ -40,6 +43,8 @@ enum {
     PLAYER_COUNT
 };
 
+_Static_assert(PLAYER_COUNT == TELEMETRY_TEAM_SIZE, "telemetry entity ids depend on the team size");
+
 enum {
     TEAM_RED = 0,
     TEAM_BLUE,
@@ -129,17 +134,28 @@ int screen(float v) {
 
 
 
-static void update_entity(entity_t *ent) {
+static uint8_t player_id(team_t *team, int player) {
+    return (uint8_t)((team - game.teams) * PLAYER_COUNT + player);
+}
+
+static void update_entity(entity_t *ent, uint8_t id) {
     simulate_entity(ent);
 
-    if (static_collide_entity(ent, &rink_collider).collide) {
+    collision_t collision = static_collide_entity(ent, &rink_collider);
+    if (collision.collide) {
         tone(340, 5, 10, TONE_TRIANGLE);
+
+        // Only report the impact, not every frame spent against the boards
+        if (!ent->touching && collision.force > 0.0f) {
+            telemetry_emit(EVENT_BOARDS, id, ENTITY_NONE, collision.force);
+        }
     }
+    ent->touching = collision.collide;
 }
 
 static void update_puck(void) {
     if (game.puck.owner == NULL) {
-        update_entity(&game.puck.ent);
+        update_entity(&game.puck.ent, ENTITY_PUCK);
 
         // Check distance to all players, to see if they can take possession of the puck
         for (int i = 0; i < PLAYER_COUNT; ++i) {
@@ -149,6 +165,10 @@ static void update_puck(void) {
                 game.teams[0].active_player = i;
             }
         }
+
+        if (game.puck.owner != NULL) {
+            telemetry_emit(EVENT_POSSESSION, player_id(&game.teams[0], game.teams[0].active_player), ENTITY_NONE, 0.0f);
+        }
     } else {
         game.puck.ent.pos = vadd(game.puck.owner->ent.pos, vscale(game.puck.owner->dir, 8.0f));
     }
@@ -189,16 +209,18 @@ static void update_team(team_t *team, uint8_t input) {
             player->ent.vel = vscale(player->ent.vel, 0.9f);
         }
 
-        update_entity(&player->ent);
+        update_entity(&player->ent, player_id(team, i));
 
         if (game.puck.owner == player) {
             if (shoot) {
                 game.puck.ent.vel = vscale(player->dir, 3.5f);
                 game.puck.owner = NULL;
+                telemetry_emit(EVENT_SHOT, player_id(team, i), ENTITY_NONE, 3.5f);
             } else if (pass) {
                 player_t *target_player = NULL;
+                int target = 0;
                 float target_angle = 0.0f;
-                vec2_t target_dir;
+                vec2_t target_dir = vzero();
 
                 for (int j = 0; j < PLAYER_COUNT; ++j) {
                     if (i == j) {
@@ -211,6 +233,7 @@ static void update_team(team_t *team, uint8_t input) {
 
                     if (angle > target_angle) {
                         target_player = other;
+                        target = j;
                         target_angle = angle;
                         target_dir = to_other;
                     }
@@ -219,9 +242,11 @@ static void update_team(team_t *team, uint8_t input) {
                 if (target_player != NULL) {
                     game.puck.ent.vel = vscale(target_dir, 2.0f);
                     game.puck.owner = NULL;
+                    telemetry_emit(EVENT_PASS, player_id(team, i), player_id(team, target), 2.0f);
                 } else {
                     game.puck.ent.vel = vscale(player->dir, 2.0f);
                     game.puck.owner = NULL;
+                    telemetry_emit(EVENT_PASS, player_id(team, i), ENTITY_NONE, 2.0f);
                 }
             }
         }
@@ -229,6 +254,7 @@ static void update_team(team_t *team, uint8_t input) {
 }
 
 static void update_game(void) {
+    telemetry_next_frame();
     update_puck();
     update_team(&game.teams[0], *GAMEPAD1);
 }
@@ -310,10 +336,12 @@ void start(void) {
 
 
     new_game();
+    telemetry_reset();
 }
 
 void update() {
     update_game();
     update_camera();
     draw();
+    telemetry_flush();
 }
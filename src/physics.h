@@ -26,6 +26,7 @@ typedef struct entity_t {
     vec2_t vel;
     float size;
     float mass;
+    bool touching;  // in contact with a static collider last update
 } entity_t;
 
 
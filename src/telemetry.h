@@ -0,0 +1,154 @@
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+// Number of events the ring buffer holds before the oldest ones are overwritten
+#define TELEMETRY_CAPACITY      64
+
+// Number of events encoded into a single trace line when draining
+#define TELEMETRY_TRACE_BATCH   16
+
+// Pending events are drained at least this often, in frames
+#define TELEMETRY_FLUSH_FRAMES  60
+
+// Entity ids used as event subject and target. Players use
+// team * TELEMETRY_TEAM_SIZE + player index.
+#define TELEMETRY_TEAM_SIZE     5
+#define ENTITY_PUCK             0xfe
+#define ENTITY_NONE             0xff
+
+enum {
+    EVENT_POSSESSION = 1,   // subject took the puck
+    EVENT_SHOT,             // subject shot the puck, value is puck speed
+    EVENT_PASS,             // subject passed to target, value is puck speed
+    EVENT_BOARDS,           // subject hit the boards, value is impact force
+    EVENT_GOAL,             // subject scored, target is the scoring team
+};
+
+// Fixed-size binary event, written as-is to event files (little endian)
+typedef struct event_t {
+    uint32_t frame;
+    uint8_t type;
+    uint8_t subject;
+    uint8_t target;
+    uint8_t reserved;
+    float value;
+} event_t;
+
+_Static_assert(sizeof(event_t) == 12, "event_t must stay 12 bytes");
+
+typedef struct telemetry_t {
+    event_t events[TELEMETRY_CAPACITY];
+    uint16_t head;
+    uint16_t count;
+    uint32_t frame;
+    uint32_t dropped;
+} telemetry_t;
+
+
+void telemetry_reset(void);
+void telemetry_next_frame(void);
+void telemetry_emit(uint8_t type, uint8_t subject, uint8_t target, float value);
+int telemetry_pop(event_t *out, int max);
+void telemetry_flush(void);
+
+#endif
+
+
+#ifdef TELEMETRY_IMPLEMENTATION
+
+static telemetry_t telemetry = {0};
+
+void telemetry_reset(void) {
+    memset(&telemetry, 0, sizeof(telemetry_t));
+}
+
+void telemetry_next_frame(void) {
+    telemetry.frame++;
+}
+
+void telemetry_emit(uint8_t type, uint8_t subject, uint8_t target, float value) {
+    uint16_t index = (uint16_t)((telemetry.head + telemetry.count) % TELEMETRY_CAPACITY);
+
+    if (telemetry.count == TELEMETRY_CAPACITY) {
+        // Full, overwrite the oldest event
+        telemetry.head = (uint16_t)((telemetry.head + 1) % TELEMETRY_CAPACITY);
+        telemetry.dropped++;
+    } else {
+        telemetry.count++;
+    }
+
+    telemetry.events[index] = (event_t) {
+        .frame = telemetry.frame,
+        .type = type,
+        .subject = subject,
+        .target = target,
+        .value = value,
+    };
+}
+
+int telemetry_pop(event_t *out, int max) {
+    int count = 0;
+
+    while (count < max && telemetry.count > 0) {
+        out[count++] = telemetry.events[telemetry.head];
+        telemetry.head = (uint16_t)((telemetry.head + 1) % TELEMETRY_CAPACITY);
+        telemetry.count--;
+    }
+
+    return count;
+}
+
+#ifndef TELEMETRY_NATIVE
+
+// Drains the buffer through trace() once it is half full or every
+// TELEMETRY_FLUSH_FRAMES, as lines of "evt:" followed by the raw event bytes
+// in hex. Overwritten events are reported as "evt-dropped:<total>".
+void telemetry_flush(void) {
+    static const char hex[] = "0123456789abcdef";
+    static char line[4 + TELEMETRY_TRACE_BATCH * sizeof(event_t) * 2 + 1];
+    static uint32_t reported_dropped = 0;
+    event_t batch[TELEMETRY_TRACE_BATCH];
+
+    if (telemetry.dropped != reported_dropped) {
+        tracef("evt-dropped:%d", (int)telemetry.dropped);
+        reported_dropped = telemetry.dropped;
+    }
+
+    if (telemetry.count == 0) {
+        return;
+    }
+    if (telemetry.count < TELEMETRY_CAPACITY / 2 && telemetry.frame % TELEMETRY_FLUSH_FRAMES != 0) {
+        return;
+    }
+
+    int count;
+    while ((count = telemetry_pop(batch, TELEMETRY_TRACE_BATCH)) > 0) {
+        const uint8_t *bytes = (const uint8_t *)batch;
+        char *out = line;
+
+        memcpy(out, "evt:", 4);
+        out += 4;
+
+        for (size_t i = 0; i < (size_t)count * sizeof(event_t); ++i) {
+            *out++ = hex[bytes[i] >> 4];
+            *out++ = hex[bytes[i] & 0x0f];
+        }
+        *out = '\0';
+
+        trace(line);
+    }
+}
+
+#else
+
+// The native runtime pops events itself after every frame
+void telemetry_flush(void) {
+}
+
+#endif
+
+#undef TELEMETRY_IMPLEMENTATION
+#endif
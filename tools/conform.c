@@ -0,0 +1,162 @@
+// Compares two state files written by the runtime (-t) frame by frame.
+//
+// Usage: conform reference.state candidate.state
+//
+// Reports the first frame whose state hash differs and the first field that
+// differs in it. Exits with 1 on divergence.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "state.h"
+
+typedef struct state_file_t {
+    const char *path;
+    FILE *file;
+    int field_count;
+    state_field_t fields[STATE_MAX_FIELDS];
+    uint32_t frame;
+    uint32_t hash;
+} state_file_t;
+
+static state_file_t reference = {0};
+static state_file_t candidate = {0};
+
+
+static bool read_header(state_file_t *state) {
+    char magic[4];
+    uint32_t field_count;
+
+    if (fread(magic, 1, 4, state->file) != 4 || memcmp(magic, STATE_MAGIC, 4) != 0)
+        return false;
+    if (fread(&field_count, sizeof(uint32_t), 1, state->file) != 1 || field_count > STATE_MAX_FIELDS)
+        return false;
+
+    state->field_count = (int)field_count;
+
+    for (int i = 0; i < state->field_count; ++i) {
+        state_field_t *field = &state->fields[i];
+        int c = fgetc(state->file);
+        if (c == EOF)
+            return false;
+        field->type = (char)c;
+
+        size_t len = 0;
+        while ((c = fgetc(state->file)) != EOF && c != '\0') {
+            if (len + 1 < sizeof(field->name))
+                field->name[len++] = (char)c;
+        }
+        if (c == EOF)
+            return false;
+        field->name[len] = '\0';
+    }
+
+    return true;
+}
+
+// Returns false at the end of the file
+static bool read_frame(state_file_t *state) {
+    if (fread(&state->frame, sizeof(uint32_t), 1, state->file) != 1)
+        return false;
+    if (fread(&state->hash, sizeof(uint32_t), 1, state->file) != 1)
+        return false;
+
+    for (int i = 0; i < state->field_count; ++i) {
+        if (fread(&state->fields[i].bits, sizeof(uint32_t), 1, state->file) != 1)
+            return false;
+    }
+
+    return true;
+}
+
+static bool open_state(state_file_t *state, const char *path) {
+    state->path = path;
+    state->file = fopen(path, "rb");
+
+    if (state->file == NULL) {
+        perror(path);
+        return false;
+    }
+    if (!read_header(state)) {
+        fprintf(stderr, "%s: not a state file\n", path);
+        return false;
+    }
+
+    return true;
+}
+
+static void print_value(const state_field_t *field) {
+    if (field->type == 'f') {
+        float value;
+        memcpy(&value, &field->bits, sizeof(float));
+        printf("%.9g (0x%08x)", (double)value, field->bits);
+    } else {
+        printf("%d", (int32_t)field->bits);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: conform reference.state candidate.state\n");
+        return 2;
+    }
+
+    if (!open_state(&reference, argv[1]) || !open_state(&candidate, argv[2]))
+        return 2;
+
+    if (reference.field_count != candidate.field_count) {
+        printf("%s: %d fields, %s: %d fields\n",
+            reference.path, reference.field_count, candidate.path, candidate.field_count);
+        return 1;
+    }
+    for (int i = 0; i < reference.field_count; ++i) {
+        if (strcmp(reference.fields[i].name, candidate.fields[i].name) != 0) {
+            printf("field %d: %s != %s\n", i, reference.fields[i].name, candidate.fields[i].name);
+            return 1;
+        }
+    }
+
+    long frames = 0;
+
+    while (true) {
+        bool has_reference = read_frame(&reference);
+        bool has_candidate = read_frame(&candidate);
+
+        if (!has_reference || !has_candidate) {
+            if (has_reference != has_candidate) {
+                printf("%s ends after %ld frames\n", has_reference ? candidate.path : reference.path, frames);
+                return 1;
+            }
+            break;
+        }
+
+        if (reference.frame != candidate.frame) {
+            printf("frame numbers differ: %u != %u\n", reference.frame, candidate.frame);
+            return 1;
+        }
+
+        if (reference.hash != candidate.hash) {
+            printf("first divergence at frame %u (hash %08x != %08x)\n",
+                reference.frame, reference.hash, candidate.hash);
+
+            for (int i = 0; i < reference.field_count; ++i) {
+                if (reference.fields[i].bits != candidate.fields[i].bits) {
+                    printf("  %s: ", reference.fields[i].name);
+                    print_value(&reference.fields[i]);
+                    printf(" != ");
+                    print_value(&candidate.fields[i]);
+                    printf("\n");
+                    break;
+                }
+            }
+            return 1;
+        }
+
+        frames++;
+    }
+
+    printf("%ld frames identical\n", frames);
+    return 0;
+}
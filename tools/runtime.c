@@ -0,0 +1,319 @@
+// Native runtime for the cart: runs the simulation without WASM-4 and
+// writes the telemetry event stream to a file.
+//
+// Usage: runtime [-i inputs] [-r record] [-s seed] [-n frames] [-e events] [-t states]
+//
+// Inputs are one GAMEPAD1 byte per frame. Without -i, pseudo random input is
+// generated from the seed so many different matches can be played back to back.
+//
+// With -t the state of game_t is written after every frame, see state.h.
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/wasm4.h"
+
+// Map the WASM-4 memory registers onto a local buffer
+static uint8_t memory[0xa0 + SCREEN_SIZE * SCREEN_SIZE / 4];
+
+#undef PALETTE
+#undef DRAW_COLORS
+#undef GAMEPAD1
+#define PALETTE ((uint32_t*)(memory + 0x04))
+#define DRAW_COLORS ((uint16_t*)(memory + 0x14))
+#define GAMEPAD1 ((const uint8_t*)(memory + 0x16))
+
+#define TELEMETRY_NATIVE
+#include "../src/main.c"
+
+#include "state.h"
+
+
+void blit(const uint8_t* data, int32_t x, int32_t y, uint32_t width, uint32_t height, uint32_t flags) {
+}
+
+void blitSub(const uint8_t* data, int32_t x, int32_t y, uint32_t width, uint32_t height,
+    uint32_t srcX, uint32_t srcY, uint32_t stride, uint32_t flags) {
+}
+
+void line(int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+}
+
+void hline(int32_t x, int32_t y, uint32_t len) {
+}
+
+void vline(int32_t x, int32_t y, uint32_t len) {
+}
+
+void oval(int32_t x, int32_t y, uint32_t width, uint32_t height) {
+}
+
+void rect(int32_t x, int32_t y, uint32_t width, uint32_t height) {
+}
+
+void text(const char* str, int32_t x, int32_t y) {
+}
+
+void tone(uint32_t frequency, uint32_t duration, uint32_t volume, uint32_t flags) {
+}
+
+uint32_t diskr(void* dest, uint32_t size) {
+    return 0;
+}
+
+uint32_t diskw(const void* src, uint32_t size) {
+    return 0;
+}
+
+void trace(const char* str) {
+    fprintf(stderr, "%s\n", str);
+}
+
+void tracef(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+
+static uint32_t random_state = 1;
+
+// Maps a nonzero seed to a xorshift state. The mix is a bijection on 32 bits
+// that only sends 0 to 0, so every nonzero seed gives its own nonzero state.
+static void random_seed(uint32_t seed) {
+    seed ^= seed >> 16;
+    seed *= 0x85ebca6bu;
+    seed ^= seed >> 13;
+    seed *= 0xc2b2ae35u;
+    seed ^= seed >> 16;
+
+    random_state = seed;
+}
+
+static uint8_t random_input(void) {
+    // xorshift32, the same sequence on every platform
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+
+    // Hold each direction for a while so players actually skate somewhere
+    static uint8_t held = 0;
+    static int frames_left = 0;
+    if (frames_left-- <= 0) {
+        held = (uint8_t)(random_state & (BUTTON_LEFT | BUTTON_RIGHT | BUTTON_UP | BUTTON_DOWN));
+        frames_left = (int)((random_state >> 8) % 30);
+    }
+
+    uint8_t buttons = 0;
+    if ((random_state >> 16) % 40 == 0)
+        buttons |= BUTTON_1;
+    if ((random_state >> 16) % 40 == 1)
+        buttons |= BUTTON_2;
+
+    return held | buttons;
+}
+
+static state_field_t state_fields[STATE_MAX_FIELDS];
+static int state_field_count = 0;
+
+static void float_field(const char *prefix, const char *name, float value) {
+    state_field_t *field = &state_fields[state_field_count++];
+
+    field->type = 'f';
+    snprintf(field->name, sizeof(field->name), "%s%s", prefix, name);
+    memcpy(&field->bits, &value, sizeof(float));
+}
+
+static void int_field(const char *prefix, const char *name, int32_t value) {
+    state_field_t *field = &state_fields[state_field_count++];
+
+    field->type = 'i';
+    snprintf(field->name, sizeof(field->name), "%s%s", prefix, name);
+    field->bits = (uint32_t)value;
+}
+
+static void entity_fields(const char *prefix, const entity_t *ent) {
+    float_field(prefix, "ent.pos.x", ent->pos.x);
+    float_field(prefix, "ent.pos.y", ent->pos.y);
+    float_field(prefix, "ent.vel.x", ent->vel.x);
+    float_field(prefix, "ent.vel.y", ent->vel.y);
+    float_field(prefix, "ent.size", ent->size);
+    float_field(prefix, "ent.mass", ent->mass);
+}
+
+// Flattens game_t into named fields. Pointers are stored as indices so the
+// state is the same across builds and address layouts.
+static void collect_state(void) {
+    char prefix[32];
+
+    state_field_count = 0;
+
+    for (int t = 0; t < 2; ++t) {
+        team_t *team = &game.teams[t];
+
+        snprintf(prefix, sizeof(prefix), "teams[%d].", t);
+        int_field(prefix, "score", team->score);
+        int_field(prefix, "active_player", team->active_player);
+
+        for (int p = 0; p < PLAYER_COUNT; ++p) {
+            player_t *player = &team->players[p];
+
+            snprintf(prefix, sizeof(prefix), "teams[%d].players[%d].", t, p);
+            entity_fields(prefix, &player->ent);
+            float_field(prefix, "dir.x", player->dir.x);
+            float_field(prefix, "dir.y", player->dir.y);
+        }
+    }
+
+    // Owner uses the same id as telemetry: team * PLAYER_COUNT + player
+    int32_t owner = ENTITY_NONE;
+    for (int t = 0; t < 2; ++t) {
+        for (int p = 0; p < PLAYER_COUNT; ++p) {
+            if (game.puck.owner == &game.teams[t].players[p])
+                owner = t * PLAYER_COUNT + p;
+        }
+    }
+
+    entity_fields("puck.", &game.puck.ent);
+    int_field("puck.", "owner", owner);
+    int_field("", "camera", game.camera);
+}
+
+// Field names only depend on the layout of game_t, so the header can be
+// written before the first frame
+static void write_state_header(FILE *file) {
+    collect_state();
+
+    uint32_t field_count = (uint32_t)state_field_count;
+
+    fwrite(STATE_MAGIC, 1, 4, file);
+    fwrite(&field_count, sizeof(uint32_t), 1, file);
+    for (int i = 0; i < state_field_count; ++i) {
+        fputc(state_fields[i].type, file);
+        fwrite(state_fields[i].name, 1, strlen(state_fields[i].name) + 1, file);
+    }
+}
+
+static void write_state(FILE *file, uint32_t frame) {
+    collect_state();
+
+    uint32_t hash = state_hash(state_fields, state_field_count);
+
+    fwrite(&frame, sizeof(uint32_t), 1, file);
+    fwrite(&hash, sizeof(uint32_t), 1, file);
+    for (int i = 0; i < state_field_count; ++i) {
+        fwrite(&state_fields[i].bits, sizeof(uint32_t), 1, file);
+    }
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: runtime [-i inputs] [-r record] [-s seed] [-n frames] [-e events] [-t states]\n");
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    const char *inputs_path = NULL;
+    const char *record_path = NULL;
+    const char *events_path = NULL;
+    const char *states_path = NULL;
+    long frames = 3600;
+
+    random_seed(1);
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 >= argc)
+            usage();
+
+        if (strcmp(argv[i], "-i") == 0)
+            inputs_path = argv[++i];
+        else if (strcmp(argv[i], "-r") == 0)
+            record_path = argv[++i];
+        else if (strcmp(argv[i], "-e") == 0)
+            events_path = argv[++i];
+        else if (strcmp(argv[i], "-t") == 0)
+            states_path = argv[++i];
+        else if (strcmp(argv[i], "-s") == 0) {
+            uint32_t seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+            if (seed == 0) {
+                fprintf(stderr, "seed must be nonzero\n");
+                return 1;
+            }
+            random_seed(seed);
+        }
+        else if (strcmp(argv[i], "-n") == 0)
+            frames = strtol(argv[++i], NULL, 0);
+        else
+            usage();
+    }
+
+    FILE *inputs = NULL;
+    FILE *record = NULL;
+    FILE *events = NULL;
+    FILE *states = NULL;
+
+    if (inputs_path != NULL && (inputs = fopen(inputs_path, "rb")) == NULL) {
+        perror(inputs_path);
+        return 1;
+    }
+    if (record_path != NULL && (record = fopen(record_path, "wb")) == NULL) {
+        perror(record_path);
+        return 1;
+    }
+    if (events_path != NULL && (events = fopen(events_path, "wb")) == NULL) {
+        perror(events_path);
+        return 1;
+    }
+
+    if (states_path != NULL && (states = fopen(states_path, "wb")) == NULL) {
+        perror(states_path);
+        return 1;
+    }
+
+    start();
+
+    if (states != NULL)
+        write_state_header(states);
+
+    for (long frame = 0; inputs != NULL || frame < frames; ++frame) {
+        uint8_t input;
+
+        if (inputs != NULL) {
+            int c = fgetc(inputs);
+            if (c == EOF)
+                break;
+            input = (uint8_t)c;
+        } else {
+            input = random_input();
+        }
+
+        memory[0x16] = input;
+        if (record != NULL)
+            fputc(input, record);
+
+        update();
+
+        event_t batch[TELEMETRY_CAPACITY];
+        int count = telemetry_pop(batch, TELEMETRY_CAPACITY);
+        if (events != NULL)
+            fwrite(batch, sizeof(event_t), (size_t)count, events);
+        if (states != NULL)
+            write_state(states, (uint32_t)frame);
+    }
+
+    if (telemetry.dropped != 0)
+        fprintf(stderr, "warning: %u telemetry events dropped\n", telemetry.dropped);
+
+    if (inputs != NULL)
+        fclose(inputs);
+    if (record != NULL)
+        fclose(record);
+    if (events != NULL)
+        fclose(events);
+    if (states != NULL)
+        fclose(states);
+
+    return 0;
+}
@@ -0,0 +1,37 @@
+// Per-frame game state files written by the runtime and read by conform.
+//
+// Layout (little endian):
+//   "W4ST", uint32 field count, then per field a type byte ('f' float,
+//   'i' int) followed by its NUL-terminated name.
+//   Per frame: uint32 frame, uint32 hash, uint32 bits for every field.
+
+#ifndef STATE_H
+#define STATE_H
+
+#include <stdint.h>
+
+#define STATE_MAGIC         "W4ST"
+#define STATE_MAX_FIELDS    128
+#define STATE_NAME_SIZE     64
+
+typedef struct state_field_t {
+    char type;
+    char name[STATE_NAME_SIZE];
+    uint32_t bits;
+} state_field_t;
+
+// FNV-1a over the field bits, so the hash only depends on the values
+static inline uint32_t state_hash(const state_field_t *fields, int count) {
+    uint32_t hash = 2166136261u;
+
+    for (int i = 0; i < count; ++i) {
+        for (int b = 0; b < 4; ++b) {
+            hash ^= (fields[i].bits >> (b * 8)) & 0xff;
+            hash *= 16777619u;
+        }
+    }
+
+    return hash;
+}
+
+#endif
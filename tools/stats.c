@@ -0,0 +1,199 @@
+// Aggregates telemetry event streams from many matches.
+//
+// Usage: stats [-t] file...
+//
+// Files are binary event streams written by the native runtime, or with -t,
+// WASM-4 console logs containing the "evt:" lines traced by the cart.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/telemetry.h"
+
+#define ENTITY_COUNT    256
+
+typedef struct entity_stats_t {
+    long possessions;
+    long shots;
+    long passes;
+    long passes_completed;
+    long board_hits;
+    double board_force;
+    float board_force_max;
+    long goals;
+} entity_stats_t;
+
+typedef struct stats_t {
+    entity_stats_t entities[ENTITY_COUNT];
+    long matches;
+    long events;
+    long dropped;
+    long event_frames;  // sum over matches of the frame of their last event
+} stats_t;
+
+static stats_t stats = {0};
+
+
+static void add_event(const event_t *event, uint8_t *last_passer, long *last_frame) {
+    entity_stats_t *subject = &stats.entities[event->subject];
+
+    stats.events++;
+    if ((long)event->frame > *last_frame)
+        *last_frame = (long)event->frame;
+
+    switch (event->type) {
+    case EVENT_POSSESSION:
+        subject->possessions++;
+        if (*last_passer != ENTITY_NONE && *last_passer != event->subject &&
+            *last_passer / TELEMETRY_TEAM_SIZE == event->subject / TELEMETRY_TEAM_SIZE) {
+            stats.entities[*last_passer].passes_completed++;
+        }
+        *last_passer = ENTITY_NONE;
+        break;
+    case EVENT_SHOT:
+        subject->shots++;
+        *last_passer = ENTITY_NONE;
+        break;
+    case EVENT_PASS:
+        subject->passes++;
+        *last_passer = event->subject;
+        break;
+    case EVENT_BOARDS:
+        subject->board_hits++;
+        subject->board_force += event->value;
+        if (event->value > subject->board_force_max)
+            subject->board_force_max = event->value;
+        break;
+    case EVENT_GOAL:
+        subject->goals++;
+        break;
+    default:
+        break;
+    }
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+static bool read_binary(FILE *file) {
+    uint8_t last_passer = ENTITY_NONE;
+    long last_frame = 0;
+    event_t event;
+
+    while (fread(&event, sizeof(event_t), 1, file) == 1) {
+        add_event(&event, &last_passer, &last_frame);
+    }
+
+    stats.event_frames += last_frame;
+    return !ferror(file);
+}
+
+static bool read_trace(FILE *file) {
+    uint8_t last_passer = ENTITY_NONE;
+    long dropped = 0;
+    long last_frame = 0;
+    char line[1024];
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        // The cart reports the running total of overwritten events
+        const char *drop = strstr(line, "evt-dropped:");
+        if (drop != NULL) {
+            dropped = strtol(drop + 12, NULL, 10);
+            continue;
+        }
+
+        const char *hex = strstr(line, "evt:");
+        if (hex == NULL)
+            continue;
+        hex += 4;
+
+        event_t event;
+        uint8_t *bytes = (uint8_t *)&event;
+        size_t filled = 0;
+
+        while (hex_value(hex[0]) >= 0 && hex_value(hex[1]) >= 0) {
+            bytes[filled++] = (uint8_t)(hex_value(hex[0]) << 4 | hex_value(hex[1]));
+            hex += 2;
+
+            if (filled == sizeof(event_t)) {
+                add_event(&event, &last_passer, &last_frame);
+                filled = 0;
+            }
+        }
+    }
+
+    stats.dropped += dropped;
+    stats.event_frames += last_frame;
+    return !ferror(file);
+}
+
+static void print_stats(void) {
+    printf("matches %ld, events %ld, frames up to last event %ld\n",
+        stats.matches, stats.events, stats.event_frames);
+    if (stats.dropped > 0)
+        printf("warning: %ld events were dropped by the cart\n", stats.dropped);
+    printf("\n");
+    printf("%-8s %6s %6s %6s %6s %6s %8s %8s %6s\n",
+        "entity", "poss", "shots", "passes", "compl", "boards", "avg-f", "max-f", "goals");
+
+    for (int i = 0; i < ENTITY_COUNT; ++i) {
+        const entity_stats_t *e = &stats.entities[i];
+        char name[16];
+
+        if (e->possessions + e->shots + e->passes + e->board_hits + e->goals == 0)
+            continue;
+
+        if (i == ENTITY_PUCK)
+            snprintf(name, sizeof(name), "puck");
+        else
+            snprintf(name, sizeof(name), "t%d.p%d", i / TELEMETRY_TEAM_SIZE, i % TELEMETRY_TEAM_SIZE);
+
+        printf("%-8s %6ld %6ld %6ld %6ld %6ld %8.3f %8.3f %6ld\n",
+            name, e->possessions, e->shots, e->passes, e->passes_completed, e->board_hits,
+            e->board_hits > 0 ? e->board_force / (double)e->board_hits : 0.0,
+            (double)e->board_force_max, e->goals);
+    }
+}
+
+int main(int argc, char **argv) {
+    bool trace_logs = false;
+    int first = 1;
+
+    if (argc > 1 && strcmp(argv[1], "-t") == 0) {
+        trace_logs = true;
+        first = 2;
+    }
+
+    if (first >= argc) {
+        fprintf(stderr, "usage: stats [-t] file...\n");
+        return 1;
+    }
+
+    for (int i = first; i < argc; ++i) {
+        FILE *file = fopen(argv[i], trace_logs ? "r" : "rb");
+        if (file == NULL) {
+            perror(argv[i]);
+            return 1;
+        }
+
+        bool ok = trace_logs ? read_trace(file) : read_binary(file);
+        fclose(file);
+
+        if (!ok) {
+            fprintf(stderr, "%s: read error\n", argv[i]);
+            return 1;
+        }
+
+        stats.matches++;
+    }
+
+    print_stats();
+    return 0;
+}